@@ -0,0 +1,634 @@
+﻿// Benchmarks.cpp
+// CS 300 – Project Two (Advising Assistance Program)
+// Micro-benchmarks for every loader step and query path of ProjectTwo.cpp.
+// Build: g++ -std=c++17 -O2 -pthread Benchmarks.cpp -o bench
+// Usage: bench [--min-exp 2] [--max-exp 7] [--reps 5] [--budget-ms 20000]
+//              [--filter name] [--json out.json | --json -]
+//        bench --check   (self-checks: allocation budget, loader and edit regression cases, memory report
+//                         accuracy, journal round trip; exits 1 on failure)
+// Notes:
+//  - Reuses the program's own functions by including ProjectTwo.cpp (its main() is
+//    compiled out), so every number measures the code that ships.
+//  - Catalogs are synthesized in memory from a fixed seed; runs are repeatable.
+//  - A case whose single repetition exceeds the time budget is not run at larger sizes
+//    (reported as "skipped") so a 10^7 sweep finishes instead of hanging.
+
+#define PROJECTTWO_NO_MAIN
+#define PROJECTTWO_COUNT_ALLOCS // allocation counts and heap tracking for the cases and checks
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-function" // menu/UI helpers are not used here
+#endif
+#include "ProjectTwo.cpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+
+namespace {
+
+// Keeps results observable so the optimizer cannot drop the measured work.
+volatile size_t g_sink = 0;
+
+struct BenchOptions {
+    int minExp = 2;
+    int maxExp = 7;
+    int reps = 5;
+    long long budgetMs = 20000;
+    string filter;
+    string jsonPath;
+    bool check = false;
+};
+
+// Synthetic catalog: N unique codes over 16 departments, each course taking up to
+// three prerequisites from earlier courses (always a DAG), plus raw user-style tokens.
+struct Dataset {
+    vector<string> lines;       // CSV rows exactly as the loader reads them
+    vector<string> rawTokens;   // un-normalized codes ("  csci000123 ")
+    vector<string> hitKeys;     // normalized codes present in the catalog (lookup sample)
+    vector<string> missKeys;    // normalized codes that are not in the catalog
+};
+
+static string MakeCode(size_t i) {
+    static const char* kDepts[] = { "CSCI", "MATH", "PHYS", "CHEM", "BIOL", "ECON", "HIST", "ENGL",
+                                    "PSYC", "STAT", "ARTS", "MUSC", "PHIL", "GEOG", "SOCI", "LING" };
+    char digits[24];
+    std::snprintf(digits, sizeof(digits), "%06zu", i / 16);
+    return string(kDepts[i % 16]) + digits;
+}
+
+static Dataset BuildDataset(size_t n) {
+    Dataset d;
+    std::mt19937_64 rng(0xC0FFEEull + n);
+    d.lines.reserve(n);
+    d.rawTokens.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        string number = MakeCode(i);
+        string title = "Synthetic Course " + std::to_string(i);
+        vector<string> prereqs;
+        size_t fanIn = i == 0 ? 0 : static_cast<size_t>(rng() % 4);
+        for (size_t k = 0; k < fanIn; ++k) {
+            string p = MakeCode(static_cast<size_t>(rng() % i));
+            if (std::find(prereqs.begin(), prereqs.end(), p) == prereqs.end()) prereqs.push_back(p);
+        }
+        string line = number + "," + title;
+        for (const string& p : prereqs) line += "," + p;
+        d.lines.push_back(std::move(line));
+
+        string raw = "  " + number + " ";
+        for (char& ch : raw) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        d.rawTokens.push_back(std::move(raw));
+        if (d.hitKeys.size() < 100000) d.hitKeys.push_back(number);
+    }
+    std::shuffle(d.hitKeys.begin(), d.hitKeys.end(), rng);
+    size_t misses = std::min<size_t>(n, 100000);
+    d.missKeys.reserve(misses);
+    for (size_t i = 0; i < misses; ++i) d.missKeys.push_back("ZZZZ" + std::to_string(900000 + i));
+    return d;
+}
+
+struct Stats {
+    double minNs = 0, medianNs = 0, meanNs = 0, stddevNs = 0, p95Ns = 0, maxNs = 0;
+};
+
+static Stats Summarize(vector<double> samples) {
+    Stats s;
+    if (samples.empty()) return s;
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    s.minNs = samples.front();
+    s.maxNs = samples.back();
+    s.medianNs = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+    double sum = 0;
+    for (double x : samples) sum += x;
+    s.meanNs = sum / n;
+    double var = 0;
+    for (double x : samples) var += (x - s.meanNs) * (x - s.meanNs);
+    s.stddevNs = n > 1 ? std::sqrt(var / (n - 1)) : 0.0;
+    s.p95Ns = samples[std::min(n - 1, static_cast<size_t>(std::ceil(0.95 * n)) - 1)];
+    return s;
+}
+
+struct Result {
+    string name;
+    size_t n = 0;
+    size_t opsPerRep = 0;
+    bool skipped = false;
+    unsigned long long allocsPerRep = 0;  // heap allocations in the last timed repetition
+    vector<double> samplesNs;
+    Stats stats;
+};
+
+// One benchmark case: setup (untimed) prepares state, run (timed) returns ops performed.
+struct Case {
+    string name;
+    std::function<void(const Dataset&)> setup;
+    std::function<size_t(const Dataset&)> run;
+};
+
+static double NowNs() {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// ---- State shared between setup and run of a case (rebuilt per repetition) ----
+HashTable* g_table = nullptr;
+
+static void ResetTable() {
+    delete g_table;
+    g_table = new HashTable();
+}
+
+// Pass 1 over every row: the table ends up holding the whole catalog.
+static void StageAll(const Dataset& d) {
+    LoadResultSummary summary;
+    Course scratch;
+    size_t lineNo = 0;
+    for (const string& line : d.lines) StageRow(line, ++lineNo, 0, *g_table, scratch, summary);
+}
+
+static vector<Case> MakeCases() {
+    vector<Case> cases;
+    cases.push_back({ "NormalizeCourse", nullptr, [](const Dataset& d) {
+        size_t acc = 0;
+        for (const string& raw : d.rawTokens) acc += NormalizeCourse(raw).size();
+        g_sink = g_sink + acc;
+        return d.rawTokens.size();
+    } });
+    cases.push_back({ "CodeBuffer::Normalize", nullptr, [](const Dataset& d) {
+        size_t acc = 0;
+        CodeBuffer buf;
+        for (const string& raw : d.rawTokens) acc += buf.Normalize(raw).size();
+        g_sink = g_sink + acc;
+        return d.rawTokens.size();
+    } });
+    cases.push_back({ "ParseLineCSV", nullptr, [](const Dataset& d) {
+        LoadResultSummary summary;
+        CourseKey number;
+        string title;
+        vector<CourseKey> prereqs;
+        size_t ok = 0, lineNo = 0;
+        for (const string& line : d.lines) ok += ParseLineCSV(line, ++lineNo, number, title, prereqs, summary);
+        g_sink = g_sink + ok;
+        return d.lines.size();
+    } });
+    cases.push_back({ "StageRow(parse+insert)", [](const Dataset&) { ResetTable(); },
+        [](const Dataset& d) {
+            StageAll(d);
+            g_sink = g_sink + g_table->Size();
+            return d.lines.size();
+        } });
+    cases.push_back({ "ResolvePrereqs", [](const Dataset& d) { ResetTable(); StageAll(d); },
+        [](const Dataset& d) {
+            LoadResultSummary summary;
+            ResolvePrereqs(*g_table, summary);
+            g_sink = g_sink + g_table->Catalog().Graph().targets.size();
+            return d.lines.size();
+        } });
+    cases.push_back({ "DetectCycles", [](const Dataset& d) {
+            ResetTable();
+            StageAll(d);
+            LoadResultSummary summary;
+            ResolvePrereqs(*g_table, summary);
+        },
+        [](const Dataset& d) {
+            LoadResultSummary summary;
+            g_sink = g_sink + DetectCycles(g_table->Catalog(), summary).size();
+            return d.lines.size();
+        } });
+    auto buildTable = [](const Dataset& d) {
+        if (g_table && g_table->Size() == d.lines.size()) return; // reuse across query cases
+        ResetTable();
+        StageAll(d);
+    };
+    cases.push_back({ "HashTable::Search(hit)", buildTable, [](const Dataset& d) {
+        size_t found = 0;
+        for (const string& k : d.hitKeys) found += g_table->Search(k) != nullptr;
+        g_sink = g_sink + found;
+        return d.hitKeys.size();
+    } });
+    cases.push_back({ "HashTable::Search(miss)", buildTable, [](const Dataset& d) {
+        size_t found = 0;
+        for (const string& k : d.missKeys) found += g_table->Search(k) != nullptr;
+        g_sink = g_sink + found;
+        return d.missKeys.size();
+    } });
+    cases.push_back({ "PrefixScan(16 depts)", [buildTable](const Dataset& d) { buildTable(d); g_table->OrderedIds(); },
+        [](const Dataset&) {
+            static const char* kDepts[] = { "CSCI", "MATH", "PHYS", "CHEM", "BIOL", "ECON", "HIST", "ENGL",
+                                            "PSYC", "STAT", "ARTS", "MUSC", "PHIL", "GEOG", "SOCI", "LING" };
+            size_t found = 0;
+            for (const char* dept : kDepts) found += g_table->PrefixScan(dept).size();
+            g_sink = g_sink + found;
+            return size_t(16);
+        } });
+    cases.push_back({ "SortedIds", buildTable, [](const Dataset& d) {
+        g_sink = g_sink + g_table->SortedIds().size();
+        return d.lines.size();
+    } });
+    cases.push_back({ "ToVectorSorted", buildTable, [](const Dataset& d) {
+        g_sink = g_sink + g_table->ToVectorSorted().size();
+        return d.lines.size();
+    } });
+    // Random-access decode of every title from a compressed copy of the table's pool.
+    // The copy is deduplicated here (compression only applies to a deduplicated pool), so
+    // the case does not depend on what earlier cases left behind.
+    static TitlePool s_titles;
+    cases.push_back({ "TitlePool::Get(compressed)", [buildTable](const Dataset& d) {
+            buildTable(d);
+            s_titles = g_table->Catalog().Titles();
+            s_titles.Dedup();
+            s_titles.Compress();
+            if (!s_titles.IsCompressed()) {
+                std::cerr << "TitlePool::Get(compressed): the pool did not compress\n";
+                std::exit(1);
+            }
+        },
+        [](const Dataset&) {
+            string scratch;
+            size_t bytes = 0;
+            for (uint32_t id = 0; id < s_titles.Count(); ++id) bytes += s_titles.Get(id, scratch).size();
+            g_sink = g_sink + bytes;
+            return s_titles.Count();
+        } });
+    // Live edits on a resolved catalog: each re-stores a course as is (update path with
+    // its cycle check), or removes one (dependent scan). Fresh table per repetition. The
+    // first edit after a load builds the dynamic topological order; it is timed on its own
+    // and done in setup for the x100 update case, which then measures the per-edge check.
+    auto buildResolved = [](const Dataset& d) {
+        ResetTable();
+        StageAll(d);
+        LoadResultSummary summary;
+        ResolvePrereqs(*g_table, summary);
+    };
+    auto firstEdit = [](const Dataset& d) {
+        size_t done = 0;
+        if (!d.hitKeys.empty()) {
+            if (CourseRef c = g_table->Search(d.hitKeys[0]))
+                done = UpsertCourse(*g_table, c.ToCourse()).kind == EditResult::kUpdated;
+        }
+        g_sink = g_sink + done;
+        return size_t{ 1 };
+    };
+    cases.push_back({ "UpsertCourse(first edit)", buildResolved, firstEdit });
+    cases.push_back({ "UpsertCourse(update x100)", [buildResolved, firstEdit](const Dataset& d) {
+            buildResolved(d);
+            firstEdit(d);
+        }, [](const Dataset& d) {
+        size_t done = 0;
+        for (size_t i = 0; i < d.hitKeys.size() && i < 100; ++i) {
+            CourseRef c = g_table->Search(d.hitKeys[i]);
+            if (!c) continue;
+            done += UpsertCourse(*g_table, c.ToCourse()).kind == EditResult::kUpdated;
+        }
+        g_sink = g_sink + done;
+        return std::min<size_t>(d.hitKeys.size(), 100);
+    } });
+    cases.push_back({ "RemoveCourse(x100)", buildResolved, [](const Dataset& d) {
+        size_t done = 0;
+        for (size_t i = 0; i < d.hitKeys.size() && i < 100; ++i) {
+            CodeBuffer buf;
+            done += RemoveCourse(*g_table, CourseKey(buf.Normalize(d.hitKeys[i]))).kind == EditResult::kRemoved;
+        }
+        g_sink = g_sink + done;
+        return std::min<size_t>(d.hitKeys.size(), 100);
+    } });
+    return cases;
+}
+
+static void WriteJson(std::ostream& os, const BenchOptions& opt, const vector<Result>& results) {
+    os << "{\n  \"benchmark\": \"ProjectTwo\",\n";
+    os << "  \"repetitions\": " << opt.reps << ",\n";
+    os << "  \"min_exp\": " << opt.minExp << ",\n  \"max_exp\": " << opt.maxExp << ",\n";
+#if defined(__VERSION__)
+    os << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+    os << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"n\": " << r.n;
+        if (r.skipped) {
+            os << ", \"skipped\": true}";
+        }
+        else {
+            double perOp = r.opsPerRep ? r.stats.medianNs / r.opsPerRep : 0.0;
+            os << ", \"ops_per_rep\": " << r.opsPerRep
+                << ", \"min_ns\": " << r.stats.minNs << ", \"median_ns\": " << r.stats.medianNs
+                << ", \"mean_ns\": " << r.stats.meanNs << ", \"stddev_ns\": " << r.stats.stddevNs
+                << ", \"p95_ns\": " << r.stats.p95Ns << ", \"max_ns\": " << r.stats.maxNs
+                << ", \"ns_per_op\": " << perOp << ", \"allocs_per_rep\": " << r.allocsPerRep
+                << ", \"samples_ns\": [";
+            for (size_t k = 0; k < r.samplesNs.size(); ++k) os << (k ? ", " : "") << r.samplesNs[k];
+            os << "]}";
+        }
+        os << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+// ---- Self-checks (bench --check): budgets the load path must keep ----
+int g_checkFailures = 0;
+
+static void Check(bool ok, const string& what) {
+    std::cout << (ok ? "PASS  " : "FAIL  ") << what << "\n";
+    if (!ok) ++g_checkFailures;
+}
+
+// Allowance for amortized container growth (doubling column arrays, bucket rehashes):
+// a fixed number of reallocations per doubling of the row count.
+static unsigned long long GrowthAllowance(size_t rows) {
+    unsigned long long doublings = 1;
+    while ((size_t{ 1 } << doublings) < rows) ++doublings;
+    return 16 * doublings;
+}
+
+// Strings are built once: staging a row allocates only its chain Node (codes are packed
+// inline, titles and prerequisite codes go to pooled columns), and validation allocates
+// per pass, not per row.
+static void CheckAllocationBudget() {
+    for (size_t n : { size_t{ 1000 }, size_t{ 100000 } }) {
+        Dataset d = BuildDataset(n);
+        ResetTable();
+        unsigned long long a0 = g_allocCount.load(std::memory_order_relaxed);
+        StageAll(d);
+        unsigned long long staged = g_allocCount.load(std::memory_order_relaxed) - a0;
+        unsigned long long budget = n + GrowthAllowance(n);
+        Check(staged <= budget, "StageRow: " + std::to_string(staged) + " allocations for " + std::to_string(n) +
+            " rows (budget " + std::to_string(budget) + ": one Node per row plus growth)");
+
+        LoadResultSummary summary;
+        a0 = g_allocCount.load(std::memory_order_relaxed);
+        ValidateAndPrune(*g_table, summary);
+        unsigned long long validated = g_allocCount.load(std::memory_order_relaxed) - a0;
+        budget = GrowthAllowance(n);
+        Check(validated <= budget, "ValidateAndPrune: " + std::to_string(validated) + " allocations for " +
+            std::to_string(n) + " rows (budget " + std::to_string(budget) + ": none per row)");
+    }
+}
+
+// Load `lines` through the loader passes into a fresh table.
+static LoadResultSummary LoadLines(const vector<string>& lines) {
+    ResetTable();
+    LoadResultSummary summary;
+    Course scratch;
+    size_t lineNo = 0;
+    for (const string& line : lines) StageRow(line, ++lineNo, 0, *g_table, scratch, summary);
+    ValidateAndPrune(*g_table, summary);
+    return summary;
+}
+
+// Small catalogs whose outcome is known exactly.
+static void CheckLoaderCases() {
+    // A1 -> C1 -> D1 -> B1 -> A1 is only reachable through an edge into a finished node.
+    LoadResultSummary s = LoadLines({ "A1,a,B1,C1", "B1,b,A1", "C1,c,D1", "D1,d,B1" });
+    Check(s.inserted == 0 && s.cycles == 1, "cycle through a cross edge: inserted " + std::to_string(s.inserted) +
+        " (want 0), cycles " + std::to_string(s.cycles) + " (want 1)");
+    s = LoadLines({ "A1,Alpha,B1", "B1,Beta,A1", "C1,Gamma,A1,D1", "D1,Delta" });
+    Check(s.inserted == 2 && s.cycles == 1 && g_table->Find(CourseKey("C1")) && g_table->Find(CourseKey("D1")),
+        "dependents of a cycle are kept: inserted " + std::to_string(s.inserted) + " (want 2)");
+    // A rejected duplicate reports nothing about its prerequisites.
+    s = LoadLines({ "A1,a,A1", "A1,dup,A1,A1" });
+    Check(s.selfPrereqs == 1 && s.issues.Count(IssueType::SelfPrereq) == 1 && s.duplicates == 1,
+        "self prereqs of a duplicate row: counted " + std::to_string(s.selfPrereqs) + ", issues " +
+        std::to_string(s.issues.Count(IssueType::SelfPrereq)) + " (want 1 and 1)");
+}
+
+// Re-adding a course that live rows still name (it was pruned from the import, or is a
+// snapshot's missing code) gives those rows their edges back, so it must be cycle-checked
+// against them.
+static void CheckEditCases() {
+    auto course = [](const char* number, const char* title, vector<CourseKey> prereqs) {
+        Course c;
+        c.number = CourseKey(number);
+        c.title = title;
+        c.prereqs = std::move(prereqs);
+        return c;
+    };
+    auto linked = [] {
+        CourseRef d = g_table->Find(CourseKey("D1"));
+        return d && d.Prereqs().size() == 1 && d.Prereq(0) && d.Prereq(0).Number() == CourseKey("A1");
+    };
+    for (int snapshot = 0; snapshot < 2; ++snapshot) {
+        const char* from = snapshot ? "missing from the snapshot" : "pruned from the import";
+        if (snapshot) {
+            ResetTable();
+            g_table->InsertRow(CourseKey("D1"), "d", vector<CourseKey>{ CourseKey("A1") }.data(), 1);
+            g_table->ResolvePrereqsVerbatim();
+        }
+        else LoadLines({ "A1,a,B1", "B1,b,A1", "D1,d,A1" });
+        EditResult r = UpsertCourse(*g_table, course("A1", "again", { CourseKey("D1") }));
+        Check(r.kind == EditResult::kRejected && r.cycles == 1 && !g_table->Find(CourseKey("A1")),
+            string("re-adding A1 (") + from + ") with prerequisite D1, which names A1, is rejected as a cycle");
+        r = UpsertCourse(*g_table, course("A1", "again", {}));
+        Check(r.kind == EditResult::kAdded && linked(),
+            string("re-adding A1 (") + from + ") links D1 to it");
+        r = UpsertCourse(*g_table, course("A1", "again", { CourseKey("D1") }));
+        Check(r.kind == EditResult::kRejected && r.cycles == 1,
+            string("then giving A1 prerequisite D1 is rejected as a cycle (") + from + ")");
+    }
+
+    // Retitling a course over and over must not grow the title pool without bound: titles
+    // nothing uses any more are dropped once they make up half of it.
+    Dataset d = BuildDataset(1000);
+    LoadLines(d.lines);
+    const TitlePool& titles = g_table->Catalog().Titles();
+    const size_t before = titles.StoredBytes();
+    vector<string> others;
+    for (size_t i = 1; i < 100; ++i) others.push_back(g_table->Search(d.hitKeys[i]).ToCourse().title);
+    Course c = g_table->Search(d.hitKeys[0]).ToCourse();
+    for (int i = 0; i < 20000; ++i) {
+        c.title = "Retitled Course " + std::to_string(i);
+        UpsertCourse(*g_table, c);
+    }
+    bool kept = g_table->Search(d.hitKeys[0]).ToCourse().title == c.title;
+    for (size_t i = 1; i < 100; ++i) kept = kept && g_table->Search(d.hitKeys[i]).ToCourse().title == others[i - 1];
+    Check(kept && titles.StoredBytes() <= 2 * before, "20000 retitles: title pool " + std::to_string(before) + " -> " +
+        std::to_string(titles.StoredBytes()) + " bytes (want at most double), titles intact");
+}
+
+// The memory report must account for what a load leaves on the heap: its total has to be
+// within 3% below to 2% above the heap growth measured across the load (the report counts
+// container capacities; the heap adds size-class rounding of those few large blocks).
+static void CheckMemoryReport() {
+    if (HeapLiveBytes() < 0) {
+        std::cout << "SKIP  memory report vs heap (heap not tracked on this platform)\n";
+        return;
+    }
+    for (size_t n : { size_t{ 1000 }, size_t{ 100000 } }) {
+        Dataset d = BuildDataset(n);
+        delete g_table;
+        g_table = nullptr;
+        const long long h0 = HeapLiveBytes();
+        {
+            LoadResultSummary summary;
+            g_table = new HashTable();
+            Course scratch;
+            size_t lineNo = 0;
+            for (const string& line : d.lines) StageRow(line, ++lineNo, 0, *g_table, scratch, summary);
+            ValidateAndPrune(*g_table, summary);
+            const long long live = HeapLiveBytes() - h0;
+            const size_t total = BuildMemoryReport(*g_table, &summary, nullptr).Total();
+            const double ratio = live > 0 ? static_cast<double>(total) / static_cast<double>(live) : 0.0;
+            char line[160];
+            std::snprintf(line, sizeof(line), "memory report: %zu bytes vs %lld on the heap for %zu rows (ratio %.3f, want 0.97..1.02)",
+                total, live, n, ratio);
+            Check(ratio >= 0.97 && ratio <= 1.02, line);
+        }
+    }
+}
+
+static string ReadFile(const string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// A journal must give back the catalog it was handed: export, restart (recover from the
+// journal into a new table), export again, and the two files must match byte for byte.
+// D1 keeps its edge to A1, which the import pruned as a cycle member.
+static void CheckJournalRoundTrip() {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "projecttwo-journal-check";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    const string before = (dir / "before.csv").string(), after = (dir / "after.csv").string();
+    LoadLines({ "A1,Alpha,B1", "B1,Beta,A1", "C1,Gamma,D1", "D1,Delta,A1" });
+    string error;
+    size_t written = 0;
+    bool ok;
+    {
+        EditJournal journal;
+        bool current = true;
+        ok = journal.Open((dir / "journal").string(), EditJournal::kDefaultCompactBytes, error) &&
+            journal.Compact(*g_table, error);
+        Course e;
+        e.number = CourseKey("E1");
+        e.title = "Epsilon";
+        e.prereqs = { CourseKey("D1") };
+        ok = ok && JournalEdit(journal, *g_table, e.number, UpsertCourse(*g_table, e), current).empty() && current;
+        ok = ok && ExportCatalogCSV(*g_table, before, written);
+    }
+    if (!ok) {
+        Check(false, "journal round trip: cannot set up the journal (" + error + ")");
+        return;
+    }
+    {
+        EditJournal journal;
+        JournalRecovery rec;
+        ResetTable();
+        ok = journal.Open((dir / "journal").string(), EditJournal::kDefaultCompactBytes, error) &&
+            RecoverJournal(journal, *g_table, rec, error) && rec.records == 1 && rec.failed == 0 &&
+            ExportCatalogCSV(*g_table, after, written);
+    }
+    const string a = ReadFile(before), b = ReadFile(after);
+    Check(ok && a == b && a.find("D1,Delta,A1\n") != string::npos,
+        "journal round trip: export after a restart matches the export before it (" + std::to_string(a.size()) +
+        " vs " + std::to_string(b.size()) + " bytes" + (error.empty() ? "" : ", " + error) + ")");
+    fs::remove_all(dir, ec);
+}
+
+static int RunChecks() {
+    CheckAllocationBudget();
+    CheckLoaderCases();
+    CheckEditCases();
+    CheckMemoryReport();
+    CheckJournalRoundTrip();
+    delete g_table;
+    g_table = nullptr;
+    std::cout << (g_checkFailures ? std::to_string(g_checkFailures) + " check(s) failed\n" : "all checks passed\n");
+    return g_checkFailures ? 1 : 0;
+}
+
+static bool ParseArgs(int argc, char* argv[], BenchOptions& opt) {
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        auto next = [&](void) -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (a == "--min-exp" && (v = next())) opt.minExp = std::atoi(v);
+        else if (a == "--max-exp" && (v = next())) opt.maxExp = std::atoi(v);
+        else if (a == "--reps" && (v = next())) opt.reps = std::max(1, std::atoi(v));
+        else if (a == "--budget-ms" && (v = next())) opt.budgetMs = std::atoll(v);
+        else if (a == "--filter" && (v = next())) opt.filter = v;
+        else if (a == "--json" && (v = next())) opt.jsonPath = v;
+        else if (a == "--check") opt.check = true;
+        else {
+            std::cerr << "Unknown or incomplete option: " << a << "\n";
+            return false;
+        }
+    }
+    opt.minExp = std::max(1, opt.minExp);
+    opt.maxExp = std::min(8, std::max(opt.minExp, opt.maxExp));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions opt;
+    if (!ParseArgs(argc, argv, opt)) return 2;
+    if (opt.check) return RunChecks();
+
+    vector<Case> cases = MakeCases();
+    std::map<string, bool> overBudget; // case name -> stop growing N
+    vector<Result> results;
+
+    std::ostream& log = (opt.jsonPath == "-") ? std::cerr : std::cout;
+    log << "benchmark                         n    reps     median(ns)      ns/op     stddev%   allocs/op\n";
+
+    for (int e = opt.minExp; e <= opt.maxExp; ++e) {
+        size_t n = 1;
+        for (int k = 0; k < e; ++k) n *= 10;
+        Dataset d = BuildDataset(n);
+
+        for (const Case& c : cases) {
+            if (!opt.filter.empty() && c.name.find(opt.filter) == string::npos) continue;
+            Result r;
+            r.name = c.name;
+            r.n = n;
+            if (overBudget[c.name]) {
+                r.skipped = true;
+                results.push_back(r);
+                log << c.name << " n=" << n << " skipped (previous size exceeded budget)\n";
+                continue;
+            }
+            for (int rep = 0; rep < opt.reps; ++rep) {
+                if (c.setup) c.setup(d);
+                unsigned long long a0 = g_allocCount.load(std::memory_order_relaxed);
+                double t0 = NowNs();
+                r.opsPerRep = c.run(d);
+                double t1 = NowNs();
+                r.allocsPerRep = g_allocCount.load(std::memory_order_relaxed) - a0;
+                r.samplesNs.push_back(t1 - t0);
+                if ((t1 - t0) / 1e6 > opt.budgetMs) { overBudget[c.name] = true; break; }
+            }
+            r.stats = Summarize(r.samplesNs);
+            results.push_back(r);
+
+            char row[160];
+            double perOp = r.opsPerRep ? r.stats.medianNs / r.opsPerRep : 0.0;
+            double cv = r.stats.meanNs > 0 ? 100.0 * r.stats.stddevNs / r.stats.meanNs : 0.0;
+            double allocsPerOp = r.opsPerRep ? static_cast<double>(r.allocsPerRep) / r.opsPerRep : 0.0;
+            std::snprintf(row, sizeof(row), "%-26s %9zu %6zu %14.0f %10.1f %10.1f %11.2f\n",
+                c.name.c_str(), n, r.samplesNs.size(), r.stats.medianNs, perOp, cv, allocsPerOp);
+            log << row;
+        }
+    }
+    delete g_table;
+    g_table = nullptr;
+
+    if (!opt.jsonPath.empty()) {
+        if (opt.jsonPath == "-") {
+            WriteJson(std::cout, opt, results);
+        }
+        else {
+            std::ofstream out(opt.jsonPath);
+            if (!out) {
+                std::cerr << "Cannot write " << opt.jsonPath << "\n";
+                return 1;
+            }
+            WriteJson(out, opt, results);
+        }
+    }
+    return 0;
+}
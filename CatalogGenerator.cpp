@@ -0,0 +1,247 @@
+// CatalogGenerator.cpp
+// CS 300 – Project Two (Advising Assistance Program)
+// Deterministic synthetic course catalogs for scale and adversarial testing.
+// Build: g++ -std=c++17 -O2 CatalogGenerator.cpp -o catalog_gen
+// Usage: catalog_gen [options] > catalog.csv
+//   --courses N        number of distinct courses (default 1000)
+//   --depts D          number of departments (default 8)
+//   --fanin F          max prerequisites per course (default 3)
+//   --depth L          DAG depth: prerequisites always point to a lower level (default 6)
+//   --cross-dept P     probability a prerequisite comes from another department (default 0.2)
+//   --cycles C         inject C prerequisite cycles of length 2..4 (default 0)
+//   --self S           inject S self-prerequisites (default 0)
+//   --dups K           emit K extra rows reusing an existing course number (default 0)
+//   --unknown U        add U references to courses that do not exist (default 0)
+//   --malformed M      emit M rows with a missing/empty number or title (default 0)
+//   --collide B        pick codes that all land in bucket 0 of the loader's Hash() mod B
+//                      (B = 179 is the initial HashTable size; the table grows past a load
+//                      factor of 1, so pass its final bucket count to stress a full
+//                      catalog); 0 disables (default)
+//   --shuffle          randomize row order (prerequisites may appear before definitions)
+//   --seed S           RNG seed (default 1); same options + seed => byte-identical output
+//   --out FILE         write to FILE instead of stdout
+// Notes:
+//  - Rows use the exact format ParseLineCSV accepts: NUMBER,Title[,PREREQ...]
+//  - A summary of what was injected is printed to stderr. Injected cycle edges can also
+//    close paths through the generated DAG, so the loader may report more cycles.
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+struct GenOptions {
+    size_t courses = 1000;
+    size_t depts = 8;
+    size_t fanIn = 3;
+    size_t depth = 6;
+    double crossDept = 0.2;
+    size_t cycles = 0;
+    size_t selfs = 0;
+    size_t dups = 0;
+    size_t unknown = 0;
+    size_t malformed = 0;
+    size_t collide = 0;
+    bool shuffle = false;
+    unsigned long long seed = 1;
+    string outPath;
+};
+
+struct Row {
+    string number;
+    string title;
+    vector<string> prereqs;
+};
+
+// Mirror of HashTable::Hash in ProjectTwo.cpp: the code is packed like CourseKey (bytes
+// big-endian in two words, length in the last byte; generated codes are always <= 15
+// bytes), the words are mixed as in CourseKey::Hash(), then reduced mod table size.
+// Kept bit-for-bit identical so --collide really stresses the shipped table.
+static size_t PackedHash(const char* p, size_t len, size_t tableSize) {
+    unsigned char b[16] = {};
+    std::memcpy(b, p, std::min<size_t>(len, 15));
+    b[15] = static_cast<unsigned char>(len);
+    uint64_t hi = 0, lo = 0;
+    for (int i = 0; i < 8; ++i) hi = (hi << 8) | b[i];
+    for (int i = 8; i < 16; ++i) lo = (lo << 8) | b[i];
+    uint64_t h = hi * 0x9E3779B97F4A7C15ull ^ (lo + 0x632BE59BD9B4E019ull);
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ull;
+    h ^= h >> 32;
+    return static_cast<size_t>(h) % tableSize;
+}
+
+// Department prefixes: four uppercase letters, deterministic for a given seed.
+static vector<string> MakeDepartments(size_t count, std::mt19937_64& rng) {
+    vector<string> out;
+    std::unordered_set<string> seen;
+    while (out.size() < count) {
+        string d(4, 'A');
+        for (char& c : d) c = static_cast<char>('A' + rng() % 26);
+        if (d == "XUNK") continue; // reserved for unknown-prereq injection
+        if (seen.insert(d).second) out.push_back(d);
+    }
+    return out;
+}
+
+static bool ParseArgs(int argc, char* argv[], GenOptions& o) {
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "--shuffle") { o.shuffle = true; continue; }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << a << "\n";
+            return false;
+        }
+        const char* v = argv[++i];
+        if (a == "--courses") o.courses = std::strtoull(v, nullptr, 10);
+        else if (a == "--depts") o.depts = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (a == "--fanin") o.fanIn = std::strtoull(v, nullptr, 10);
+        else if (a == "--depth") o.depth = std::max<size_t>(1, std::strtoull(v, nullptr, 10));
+        else if (a == "--cross-dept") o.crossDept = std::atof(v);
+        else if (a == "--cycles") o.cycles = std::strtoull(v, nullptr, 10);
+        else if (a == "--self") o.selfs = std::strtoull(v, nullptr, 10);
+        else if (a == "--dups") o.dups = std::strtoull(v, nullptr, 10);
+        else if (a == "--unknown") o.unknown = std::strtoull(v, nullptr, 10);
+        else if (a == "--malformed") o.malformed = std::strtoull(v, nullptr, 10);
+        else if (a == "--collide") o.collide = std::strtoull(v, nullptr, 10);
+        else if (a == "--seed") o.seed = std::strtoull(v, nullptr, 10);
+        else if (a == "--out") o.outPath = v;
+        else {
+            std::cerr << "Unknown option: " << a << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    GenOptions opt;
+    if (!ParseArgs(argc, argv, opt)) return 2;
+
+    std::mt19937_64 rng(opt.seed);
+    auto pick = [&rng](size_t n) { return static_cast<size_t>(rng() % n); };
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+    const vector<string> depts = MakeDepartments(opt.depts, rng);
+    const size_t n = opt.courses;
+
+    // Pass 1: course numbers. Course i belongs to department i % D; in collide mode,
+    // candidate numbers are skipped until one hashes into bucket 0.
+    vector<Row> rows(n);
+    vector<size_t> nextNum(depts.size(), 100);
+    for (size_t i = 0; i < n; ++i) {
+        size_t d = i % depts.size();
+        if (opt.collide > 0) {
+            // Build each candidate in a stack buffer (no string per try).
+            char code[32];
+            std::memcpy(code, depts[d].data(), depts[d].size());
+            char* digits = code + depts[d].size();
+            while (true) {
+                size_t len = static_cast<size_t>(std::to_chars(digits, code + sizeof(code), nextNum[d]).ptr - code);
+                if (PackedHash(code, len, opt.collide) == 0) break;
+                ++nextNum[d];
+            }
+        }
+        rows[i].number = depts[d] + std::to_string(nextNum[d]++);
+        rows[i].title = "Course " + depts[d] + " " + std::to_string(i);
+    }
+
+    // Pass 2: prerequisites. Levels are contiguous index ranges, so "any earlier level"
+    // is the prefix [0, levelStart). Same-department picks walk back in strides of D.
+    auto levelStart = [&](size_t i) { return (i * opt.depth / std::max<size_t>(n, 1)) * n / opt.depth; };
+    for (size_t i = 0; i < n; ++i) {
+        size_t limit = levelStart(i);
+        if (limit == 0 || opt.fanIn == 0) continue;
+        size_t want = pick(opt.fanIn + 1);
+        for (size_t k = 0; k < want; ++k) {
+            size_t j;
+            size_t sameDeptCount = (limit + depts.size() - 1 - (i % depts.size())) / depts.size();
+            if (coin(rng) >= opt.crossDept && sameDeptCount > 0 && (i % depts.size()) < limit)
+                j = (i % depts.size()) + depts.size() * pick(sameDeptCount);
+            else
+                j = pick(limit);
+            const string& p = rows[j].number;
+            vector<string>& pr = rows[i].prereqs;
+            if (std::find(pr.begin(), pr.end(), p) == pr.end()) pr.push_back(p);
+        }
+    }
+
+    // Adversarial injections (all applied to valid rows before extra rows are appended).
+    size_t injectedCycles = 0, injectedSelfs = 0, injectedUnknown = 0;
+    for (size_t c = 0; c < opt.cycles && n >= 2; ++c) {
+        size_t len = std::min<size_t>(n, 2 + pick(3));
+        vector<size_t> members;
+        while (members.size() < len) {
+            size_t m = pick(n);
+            if (std::find(members.begin(), members.end(), m) == members.end()) members.push_back(m);
+        }
+        for (size_t k = 0; k < len; ++k) {
+            vector<string>& pr = rows[members[k]].prereqs;
+            const string& target = rows[members[(k + 1) % len]].number;
+            if (std::find(pr.begin(), pr.end(), target) == pr.end()) pr.push_back(target);
+        }
+        ++injectedCycles;
+    }
+    for (size_t s = 0; s < opt.selfs && n > 0; ++s, ++injectedSelfs) {
+        Row& r = rows[pick(n)];
+        r.prereqs.push_back(r.number);
+    }
+    for (size_t u = 0; u < opt.unknown && n > 0; ++u, ++injectedUnknown) {
+        rows[pick(n)].prereqs.push_back("XUNK" + std::to_string(100000 + u));
+    }
+
+    vector<string> lines;
+    lines.reserve(n + opt.dups + opt.malformed);
+    for (const Row& r : rows) {
+        string line = r.number + "," + r.title;
+        for (const string& p : r.prereqs) line += "," + p;
+        lines.push_back(std::move(line));
+    }
+    for (size_t k = 0; k < opt.dups && n > 0; ++k) {
+        const Row& r = rows[pick(n)];
+        lines.push_back(r.number + ",Duplicate of " + r.number);
+    }
+    for (size_t k = 0; k < opt.malformed; ++k) {
+        string code = n > 0 ? rows[pick(n)].number : string("NONE100");
+        switch (k % 3) {
+        case 0: lines.push_back(code); break;                      // missing title field
+        case 1: lines.push_back(",Title without number"); break;   // empty course number
+        default: lines.push_back(code + ",   "); break;            // empty title
+        }
+    }
+    if (opt.shuffle) std::shuffle(lines.begin(), lines.end(), rng);
+
+    FILE* out = stdout;
+    if (!opt.outPath.empty()) {
+        out = std::fopen(opt.outPath.c_str(), "wb");
+        if (!out) {
+            std::cerr << "Cannot open output file: " << opt.outPath << "\n";
+            return 1;
+        }
+    }
+    static char ioBuf[1 << 20];
+    std::setvbuf(out, ioBuf, _IOFBF, sizeof(ioBuf));
+    for (const string& line : lines) {
+        std::fwrite(line.data(), 1, line.size(), out);
+        std::fputc('\n', out);
+    }
+    bool ok = std::fflush(out) == 0;
+    if (out != stdout) ok = (std::fclose(out) == 0) && ok;
+
+    std::cerr << "generated rows=" << lines.size() << " courses=" << n << " depts=" << depts.size()
+        << " cycles=" << injectedCycles << " self=" << injectedSelfs << " unknown=" << injectedUnknown
+        << " dups=" << opt.dups << " malformed=" << opt.malformed
+        << " collide=" << opt.collide << " seed=" << opt.seed << "\n";
+    return ok ? 0 : 1;
+}